@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hashtable.h"
+#include "radix.h"
+
+/*
+ * Longest-prefix routing benchmark: linear sv_starts_with scan vs
+ * HashTable (probe every prefix length of the request) vs RadixTree.
+ * Usage: ./benchradix [num_prefixes] [num_queries]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint sv_hash(const void *v) {
+    const stringv *sv = v;
+    uint hash = 5381;
+    for (size_t i = 0; i < sv->len; i++) {
+        hash = ((hash << 5) + hash) + (unsigned char)sv->p[i];
+    }
+    return hash;
+}
+
+static int sv_equal(const void *a, const void *b) {
+    return sv_eq(*(const stringv*)a, *(const stringv*)b);
+}
+
+static stringv sv_dup(char *cstr) {
+    stringb sb = sb_from_cstr(cstr);
+    return sv_from_sb(sb);
+}
+
+static void *linear_longest_prefix(stringv *prefixes, size_t n, stringv sv) {
+    stringv *best = NULL;
+    for (size_t i = 0; i < n; i++) {
+        if (sv_starts_with(sv, prefixes[i]) && (!best || prefixes[i].len > best->len)) {
+            best = &prefixes[i];
+        }
+    }
+    return best;
+}
+
+static void *hash_longest_prefix(HashTable *table, stringv sv) {
+    for (size_t len = sv.len + 1; len-- > 0;) {
+        stringv probe = sv_from_parts(sv.p, len);
+        void *value = hashtable_lookup(table, &probe);
+        if (value) return value;
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    size_t num_prefixes = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000;
+    size_t num_queries = argc > 2 ? strtoul(argv[2], NULL, 10) : 200000;
+    static const char *services[] = {"api", "static", "admin", "auth", "media", "internal"};
+
+    srand(42);
+
+    stringv *prefixes = malloc(num_prefixes * sizeof(stringv));
+    for (size_t i = 0; i < num_prefixes; i++) {
+        char buf[96];
+        snprintf(buf, sizeof(buf), "/%s/v%d/resource%zu/",
+                 services[rand() % SIZEOF(services)], rand() % 4, i);
+        prefixes[i] = sv_dup(buf);
+    }
+
+    stringv *queries = malloc(num_queries * sizeof(stringv));
+    for (size_t i = 0; i < num_queries; i++) {
+        char buf[160];
+        stringv base = prefixes[rand() % num_prefixes];
+        /* One in eight requests misses every route */
+        snprintf(buf, sizeof(buf), "%s%.*sitem/%d?q=%d",
+                 rand() % 8 ? "" : "/nope", (int)base.len, base.p, rand(), rand());
+        queries[i] = sv_dup(buf);
+    }
+
+    HashTable *table = hashtable_new(sv_hash, sv_equal);
+    RadixTree *tree = radix_new();
+    for (size_t i = 0; i < num_prefixes; i++) {
+        hashtable_insert(table, &prefixes[i], &prefixes[i]);
+        radix_insert(tree, prefixes[i], &prefixes[i]);
+    }
+
+    printf("%zu prefixes, %zu queries\n", num_prefixes, num_queries);
+
+    /* The linear scan is slow, so it runs on a slice and is scaled per query */
+    size_t linear_queries = MIN(num_queries, (size_t)2000);
+    size_t hits = 0;
+    double t = now_sec();
+    for (size_t i = 0; i < linear_queries; i++) {
+        hits += linear_longest_prefix(prefixes, num_prefixes, queries[i]) != NULL;
+    }
+    double linear = (now_sec() - t) / linear_queries;
+
+    size_t hash_hits = 0;
+    t = now_sec();
+    for (size_t i = 0; i < num_queries; i++) {
+        hash_hits += hash_longest_prefix(table, queries[i]) != NULL;
+    }
+    double hashed = (now_sec() - t) / num_queries;
+
+    size_t radix_hits = 0;
+    t = now_sec();
+    for (size_t i = 0; i < num_queries; i++) {
+        radix_hits += radix_longest_prefix(tree, queries[i], NULL) != NULL;
+    }
+    double radix = (now_sec() - t) / num_queries;
+
+    printf("longest prefix  linear sv_starts_with %10.1f ns/query (%zu/%zu hits)\n",
+           linear * 1e9, hits, linear_queries);
+    printf("longest prefix  HashTable probes      %10.1f ns/query (%zu hits)\n", hashed * 1e9, hash_hits);
+    printf("longest prefix  RadixTree             %10.1f ns/query (%zu hits)\n", radix * 1e9, radix_hits);
+
+    /* Exact lookups of the stored prefixes */
+    size_t found = 0;
+    t = now_sec();
+    for (size_t i = 0; i < num_queries; i++) {
+        found += hashtable_lookup(table, &prefixes[i % num_prefixes]) != NULL;
+    }
+    hashed = (now_sec() - t) / num_queries;
+
+    t = now_sec();
+    for (size_t i = 0; i < num_queries; i++) {
+        found += radix_lookup(tree, prefixes[i % num_prefixes]) != NULL;
+    }
+    radix = (now_sec() - t) / num_queries;
+
+    printf("exact lookup    HashTable             %10.1f ns/query\n", hashed * 1e9);
+    printf("exact lookup    RadixTree             %10.1f ns/query\n", radix * 1e9);
+    printf("(%zu found)\n", found);
+
+    hashtable_destroy(table);
+    radix_destroy(tree);
+    for (size_t i = 0; i < num_prefixes; i++) free(prefixes[i].p);
+    for (size_t i = 0; i < num_queries; i++) free(queries[i].p);
+    free(prefixes);
+    free(queries);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utf8.h"
+
+/*
+ * Throughput of the UTF-8 kernels in GB/s, per available implementation.
+ * Usage: ./benchutf8 [size_mib]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void fill(char *buf, size_t len, char **pieces, size_t num_pieces) {
+    size_t i = 0;
+    while (i < len) {
+        char *piece = pieces[rand() % num_pieces];
+        size_t n = strlen(piece);
+        if (i + n > len) {
+            memset(buf + i, 'x', len - i);
+            break;
+        }
+        memcpy(buf + i, piece, n);
+        i += n;
+    }
+}
+
+static void run(const char *label, const char *buf, size_t len) {
+    static const char *kernels[] = {"avx2", "ssse3", "scalar"};
+    int reps = 20;
+
+    for (size_t k = 0; k < SIZEOF(kernels); k++) {
+        if (!utf8_use_kernel(kernels[k])) continue;
+
+        size_t valid = 0;
+        double t = now_sec();
+        for (int r = 0; r < reps; r++) valid += utf8_validate(buf, len);
+        double validate = now_sec() - t;
+
+        size_t count = 0;
+        t = now_sec();
+        for (int r = 0; r < reps; r++) count += utf8_count(buf, len);
+        double counted = now_sec() - t;
+
+        printf("%-8s %-7s validate %7.2f GB/s   count %7.2f GB/s   (%zu/%d valid, %zu cp)\n",
+               label, kernels[k], len * reps / validate / 1e9, len * reps / counted / 1e9,
+               valid, reps, count / reps);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    size_t len = mib << 20;
+    char *buf = malloc(len);
+
+    char *ascii[] = {"the ", "quick ", "brown ", "fox ", "jumps\n"};
+    char *latin[] = {"caf\xc3\xa9 ", "na\xc3\xafve ", "stra\xc3\x9f" "e ", "over "};
+    char *mixed[] = {"hello ", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e ", "\xd0\xbf\xd1\x80\xd0\xb8 ",
+                     "\xf0\x9f\x98\x80 ", "\xe2\x82\xac"};
+
+    srand(7);
+    printf("%zu MiB buffers, default kernel %s\n", mib, utf8_kernel());
+
+    fill(buf, len, ascii, SIZEOF(ascii));
+    run("ascii", buf, len);
+    fill(buf, len, latin, SIZEOF(latin));
+    run("latin", buf, len);
+    fill(buf, len, mixed, SIZEOF(mixed));
+    run("mixed", buf, len);
+
+    free(buf);
+    return 0;
+}
@@ -1,15 +1,17 @@
 #!/usr/bin/env python3
 """
 Search C/C++ header files for functions by return type and argument types
-Usage: python c_parser.py <file.h> ["search query"]
+Usage: python c_parser.py <file.h|dir> ["search query"]
        python c_parser.py mycode.h "void*"
        python c_parser.py mycode.h              (interactive mode)
+       python c_parser.py include/ "char*,"     (every header under include/)
+Parsed headers are cached on disk, see symindex.py
 """
 
-import clang.cindex
 from pathlib import Path
 import sys
 from collections import Counter
+from symindex import TypeIndex, load_index, normalize_type
 
 # ANSI color codes
 COLOR_TYPE = '\033[36m'      # Cyan for types
@@ -18,63 +20,6 @@ COLOR_RESET = '\033[0m'      # Reset to default
 UNDERLINE = '\033[4m'        # Underline
 UNDERLINE_OFF = '\033[24m'   # Underline off
 
-def normalize_type(type_str):
-    """Normalize type string for comparison"""
-    # Remove const
-    type_str = type_str.replace('const', '').strip()
-    # Normalize whitespace around asterisks for pointer types
-    type_str = type_str.replace('*', ' * ')
-    # Normalize whitespace
-    type_str = ' '.join(type_str.split())
-    # Case insensitive
-    type_str = type_str.lower()
-    return type_str
-
-def parse_functions(header_path):
-    """Parse C/C++ header and extract functions"""
-    
-    index = clang.cindex.Index.create()
-    translation_unit = index.parse(
-        header_path,
-        args=['-x', 'c++']
-    )
-    
-    functions = []
-    
-    def visit_node(node):
-        """Recursively visit AST nodes"""
-        
-        if node.location.file and str(node.location.file) == str(header_path):
-            
-            if node.kind == clang.cindex.CursorKind.FUNCTION_DECL:
-                return_type = normalize_type(node.result_type.spelling)
-                func_name = node.spelling
-                
-                # Get parameters
-                param_types = []
-                params = []
-                for arg in node.get_arguments():
-                    param_type = normalize_type(arg.type.spelling)
-                    param_types.append(param_type)
-                    param_name = arg.spelling or ""
-                    params.append(f"{arg.type.spelling} {param_name}".strip())
-                
-                param_str = ", ".join(params) if params else "void"
-                
-                functions.append({
-                    'name': func_name,
-                    'return_type': return_type,
-                    'param_types': param_types,
-                    'signature': f"{node.result_type.spelling} {func_name}({param_str})",
-                    'line': node.location.line
-                })
-        
-        for child in node.get_children():
-            visit_node(child)
-    
-    visit_node(translation_unit.cursor)
-    return functions
-
 def format_signature(func, search_terms=None):
     """Format function signature with colors and highlight search terms"""
     return_type = func['signature'].split(func['name'])[0].strip()
@@ -95,7 +40,7 @@ def format_signature(func, search_terms=None):
     
     return f"{COLOR_TYPE}{return_type}{COLOR_RESET} {COLOR_NAME}{func['name']}{COLOR_RESET}{rest}"
 
-def search_functions(functions, query):
+def search_functions(type_index, query):
     """
     Search functions by return type and argument types
     Rules:
@@ -103,6 +48,7 @@ def search_functions(functions, query):
     - ",int,float" -> functions with those args (any return type)
     - "int" (no comma) -> functions with int in return type OR arguments
     """
+    functions = type_index.functions
     if not query.strip():
         return functions
     
@@ -111,16 +57,8 @@ def search_functions(functions, query):
     # No comma: search in both return type and arguments
     if not has_comma:
         search_term = normalize_type(query.strip())
-        matches = []
-        for func in functions:
-            # Check return type
-            if search_term in func['return_type']:
-                matches.append(func)
-                continue
-            # Check any argument
-            if any(search_term in ptype for ptype in func['param_types']):
-                matches.append(func)
-        return matches
+        ids = type_index.returning(search_term) | type_index.taking(search_term)
+        return [functions[i] for i in sorted(ids)]
     
     # Has comma: parse parts
     parts = [normalize_type(p.strip()) for p in query.split(',')]
@@ -133,22 +71,28 @@ def search_functions(functions, query):
         search_return_type = parts[0] if parts[0] else None
         search_arg_types = Counter(parts[1:]) if len(parts) > 1 else Counter()
     
+    # Narrow down candidates with the type index (None means no constraint)
+    candidates = None
+    if search_return_type:
+        candidates = set(type_index.returning(search_return_type))
+    for arg_type in search_arg_types:
+        if not arg_type:  # Skip empty strings
+            continue
+        ids = type_index.taking(arg_type)
+        candidates = set(ids) if candidates is None else candidates & ids
+    
+    if candidates is None:
+        return functions
+    
     matches = []
     
-    for func in functions:
-        # Check return type (skip if None means any return type)
-        if search_return_type is not None:
-            if not search_return_type:
-                # Empty but not None means no specific requirement beyond args
-                pass
-            elif search_return_type not in func['return_type']:
-                continue
-        
+    for i in sorted(candidates):
+        func = functions[i]
         # Check argument types (order doesn't matter)
         # All searched arg types must be present in function
         match = True
         for arg_type, count in search_arg_types.items():
-            if not arg_type:  # Skip empty strings
+            if not arg_type or count == 1:  # Presence already checked by the index
                 continue
             # Check if the arg_type is a substring of any function param type
             found_count = sum(1 for ftype in func['param_types'] if arg_type in ftype)
@@ -164,12 +108,12 @@ def search_functions(functions, query):
 def main():
     # Require at least one argument (the header file)
     if len(sys.argv) < 2:
-        print("Usage: python c_parser.py <file.h> [search query]")
+        print("Usage: python c_parser.py <file.h|dir> [search query]")
         print("       python c_parser.py mycode.h \"void*\"")
         print("       python c_parser.py mycode.h              (interactive mode)")
         sys.exit(1)
     
-    # First argument is always the header file
+    # First argument is always the header file (or a directory of headers)
     header_path = Path(sys.argv[1])
     search_query = ' '.join(sys.argv[2:]) if len(sys.argv) > 2 else None
     
@@ -177,9 +121,10 @@ def main():
         print(f"Error: {header_path} not found!")
         sys.exit(1)
     
-    print(f"Parsing {header_path}...\n")
-    functions = parse_functions(header_path)
-    print(f"Loaded {len(functions)} functions\n")
+    print(f"Indexing {header_path}...\n")
+    headers, index = load_index([header_path])
+    type_index = TypeIndex(index.items(headers, kinds=('functions',)))
+    print(f"Loaded {len(type_index.functions)} functions from {len(headers)} headers\n")
     
     # Interactive search loop
     print("Search rules:")
@@ -202,7 +147,7 @@ def main():
             if query.lower() in ('quit', 'exit', 'q'):
                 break
             
-            matches = search_functions(functions, query)
+            matches = search_functions(type_index, query)
             
             # Extract search terms for highlighting
             search_terms = []
@@ -216,7 +161,7 @@ def main():
             print(f"MATCHES: {len(matches)}")
             print(f"{'=' * 70}\n")
             
-            for func in sorted(matches, key=lambda x: x['line']):
+            for func in sorted(matches, key=lambda x: (x['file'], x['line'])):
                 print(f"{format_signature(func, search_terms)};")
             
             print()
@@ -1,7 +1,11 @@
 #include "ma.h"
-#include <ctype.h>
 #include <stdio.h>
 
+/* ASCII whitespace only; isspace() depends on the locale */
+static bool is_space(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
 stringv sv_chop_by_delim(stringv *sv, char delim) {
   size_t i = 0;
   while (i < sv->len && sv->p[i] != delim) {
@@ -43,7 +47,7 @@ stringv sv_from_parts(char *p, size_t len) {
 
 stringv sv_trim_left(stringv sv) {
   size_t i = 0;
-  while (i < sv.len && isspace(sv.p[i])) {
+  while (i < sv.len && is_space(sv.p[i])) {
     i += 1;
   }
 
@@ -52,7 +56,7 @@ stringv sv_trim_left(stringv sv) {
 
 stringv sv_trim_right(stringv sv) {
   size_t i = 0;
-  while (i < sv.len && isspace(sv.p[sv.len - 1 - i])) {
+  while (i < sv.len && is_space(sv.p[sv.len - 1 - i])) {
     i += 1;
   }
 
@@ -0,0 +1,648 @@
+#include "radix.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+enum { NODE4, NODE16, NODE48, NODE256 };
+
+typedef struct _RadixNode {
+    uint8_t type;
+    uint16_t num_children;
+    uint32_t prefix_len;
+    unsigned char prefix[RADIX_MAX_PREFIX];
+    RadixLeaf *leaf;            /* key that ends right after the prefix */
+} RadixNode;
+
+/* Node4/Node16 keep their keys sorted so children can be walked in order */
+typedef struct {
+    RadixNode n;
+    unsigned char keys[4];
+    void *children[4];
+} RadixNode4;
+
+typedef struct {
+    RadixNode n;
+    unsigned char keys[16];
+    void *children[16];
+} RadixNode16;
+
+typedef struct {
+    RadixNode n;
+    unsigned char index[256];   /* slot + 1, 0 means no child */
+    void *children[48];
+} RadixNode48;
+
+typedef struct {
+    RadixNode n;
+    void *children[256];
+} RadixNode256;
+
+static const size_t node_sizes[4] = {
+    sizeof(RadixNode4), sizeof(RadixNode16),
+    sizeof(RadixNode48), sizeof(RadixNode256),
+};
+
+/* Children are either nodes or leaves; leaves are tagged in the low bit */
+#define IS_LEAF(x) (((uintptr_t)(x)) & 1)
+#define TO_LEAF(x) ((RadixLeaf*)((uintptr_t)(x) & ~(uintptr_t)1))
+#define MAKE_LEAF(l) ((void*)((uintptr_t)(l) | 1))
+
+#define POOL_ALIGN 16
+
+/* Pool */
+
+static void* pool_alloc(RadixPool *pool, size_t size) {
+    size = (size + POOL_ALIGN - 1) & ~(size_t)(POOL_ALIGN - 1);
+
+    if (size > pool->left) {
+        /* Oversized requests (long keys) get their own block */
+        size_t block_size = size > RADIX_POOL_BLOCK / 4 ? POOL_ALIGN + size : RADIX_POOL_BLOCK;
+        RadixPoolBlock *block = malloc(block_size);
+        if (!block) return NULL;
+
+        block->next = pool->blocks;
+        pool->blocks = block;
+
+        if (block_size != RADIX_POOL_BLOCK) {
+            return (char*)block + POOL_ALIGN;
+        }
+        pool->cur = (char*)block + POOL_ALIGN;
+        pool->left = RADIX_POOL_BLOCK - POOL_ALIGN;
+    }
+
+    void *p = pool->cur;
+    pool->cur += size;
+    pool->left -= size;
+    return p;
+}
+
+static void pool_destroy(RadixPool *pool) {
+    RadixPoolBlock *block = pool->blocks;
+    while (block) {
+        RadixPoolBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+static RadixNode* node_new(RadixPool *pool, int type) {
+    RadixNode *n = pool->free_nodes[type];
+    if (n) {
+        pool->free_nodes[type] = *(void**)n;
+    } else {
+        n = pool_alloc(pool, node_sizes[type]);
+        if (!n) return NULL;
+    }
+
+    memset(n, 0, node_sizes[type]);
+    n->type = type;
+    return n;
+}
+
+static void node_free(RadixPool *pool, RadixNode *n) {
+    int type = n->type;
+    *(void**)n = pool->free_nodes[type];
+    pool->free_nodes[type] = n;
+}
+
+static RadixLeaf* leaf_new(RadixPool *pool, stringv key, void *value) {
+    RadixLeaf *leaf = pool_alloc(pool, sizeof(RadixLeaf) + key.len);
+    if (!leaf) return NULL;
+
+    leaf->value = value;
+    leaf->len = key.len;
+    if (key.len) memcpy(leaf->key, key.p, key.len);
+    return leaf;
+}
+
+/* Node helpers */
+
+static void** find_child(RadixNode *n, unsigned char c) {
+    switch (n->type) {
+    case NODE4: {
+        RadixNode4 *p = (RadixNode4*)n;
+        for (int i = 0; i < n->num_children; i++) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+        break;
+    }
+    case NODE16: {
+        RadixNode16 *p = (RadixNode16*)n;
+#ifdef __SSE2__
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+                                     _mm_loadu_si128((const __m128i*)p->keys));
+        unsigned mask = _mm_movemask_epi8(cmp) & ((1u << n->num_children) - 1);
+        if (mask) return &p->children[__builtin_ctz(mask)];
+#else
+        for (int i = 0; i < n->num_children; i++) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+#endif
+        break;
+    }
+    case NODE48: {
+        RadixNode48 *p = (RadixNode48*)n;
+        if (p->index[c]) return &p->children[p->index[c] - 1];
+        break;
+    }
+    case NODE256: {
+        RadixNode256 *p = (RadixNode256*)n;
+        if (p->children[c]) return &p->children[c];
+        break;
+    }
+    }
+    return NULL;
+}
+
+/* Number of keys smaller than c, i.e. the insert position in a sorted node */
+static int lower_bound16(const unsigned char *keys, int num, unsigned char c) {
+#ifdef __SSE2__
+    /* SSE2 only has a signed byte compare, so flip the sign bit first */
+    __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i k = _mm_xor_si128(_mm_loadu_si128((const __m128i*)keys), bias);
+    __m128i v = _mm_xor_si128(_mm_set1_epi8((char)c), bias);
+    unsigned mask = _mm_movemask_epi8(_mm_cmplt_epi8(k, v)) & ((1u << num) - 1);
+    return __builtin_popcount(mask);
+#else
+    int i = 0;
+    while (i < num && keys[i] < c) i++;
+    return i;
+#endif
+}
+
+static void copy_header(RadixNode *dst, const RadixNode *src) {
+    dst->num_children = src->num_children;
+    dst->prefix_len = src->prefix_len;
+    memcpy(dst->prefix, src->prefix, sizeof(dst->prefix));
+    dst->leaf = src->leaf;
+}
+
+/* Add a child under byte c, growing the node (and updating *ref) if full */
+static int add_child(RadixPool *pool, void **ref, RadixNode *n, unsigned char c, void *child) {
+    switch (n->type) {
+    case NODE4: {
+        RadixNode4 *p = (RadixNode4*)n;
+        if (n->num_children < 4) {
+            int pos = 0;
+            while (pos < n->num_children && p->keys[pos] < c) pos++;
+            memmove(p->keys + pos + 1, p->keys + pos, n->num_children - pos);
+            memmove(p->children + pos + 1, p->children + pos,
+                    (n->num_children - pos) * sizeof(void*));
+            p->keys[pos] = c;
+            p->children[pos] = child;
+            n->num_children++;
+            return 1;
+        }
+
+        RadixNode16 *grown = (RadixNode16*)node_new(pool, NODE16);
+        if (!grown) return 0;
+        copy_header(&grown->n, n);
+        memcpy(grown->keys, p->keys, 4);
+        memcpy(grown->children, p->children, 4 * sizeof(void*));
+        node_free(pool, n);
+        *ref = grown;
+        return add_child(pool, ref, &grown->n, c, child);
+    }
+    case NODE16: {
+        RadixNode16 *p = (RadixNode16*)n;
+        if (n->num_children < 16) {
+            int pos = lower_bound16(p->keys, n->num_children, c);
+            memmove(p->keys + pos + 1, p->keys + pos, n->num_children - pos);
+            memmove(p->children + pos + 1, p->children + pos,
+                    (n->num_children - pos) * sizeof(void*));
+            p->keys[pos] = c;
+            p->children[pos] = child;
+            n->num_children++;
+            return 1;
+        }
+
+        RadixNode48 *grown = (RadixNode48*)node_new(pool, NODE48);
+        if (!grown) return 0;
+        copy_header(&grown->n, n);
+        for (int i = 0; i < 16; i++) {
+            grown->index[p->keys[i]] = i + 1;
+            grown->children[i] = p->children[i];
+        }
+        node_free(pool, n);
+        *ref = grown;
+        return add_child(pool, ref, &grown->n, c, child);
+    }
+    case NODE48: {
+        RadixNode48 *p = (RadixNode48*)n;
+        if (n->num_children < 48) {
+            /* Nothing is ever removed, so slots stay dense */
+            p->children[n->num_children] = child;
+            p->index[c] = n->num_children + 1;
+            n->num_children++;
+            return 1;
+        }
+
+        RadixNode256 *grown = (RadixNode256*)node_new(pool, NODE256);
+        if (!grown) return 0;
+        copy_header(&grown->n, n);
+        for (int i = 0; i < 256; i++) {
+            if (p->index[i]) grown->children[i] = p->children[p->index[i] - 1];
+        }
+        node_free(pool, n);
+        *ref = grown;
+        return add_child(pool, ref, &grown->n, c, child);
+    }
+    case NODE256: {
+        RadixNode256 *p = (RadixNode256*)n;
+        p->children[c] = child;
+        n->num_children++;
+        return 1;
+    }
+    }
+    return 0;
+}
+
+/* Next child at or after *pos in key order, NULL when exhausted */
+static void* next_child(RadixNode *n, int *pos, unsigned char *c) {
+    switch (n->type) {
+    case NODE4:
+    case NODE16: {
+        const unsigned char *keys = n->type == NODE4 ? ((RadixNode4*)n)->keys : ((RadixNode16*)n)->keys;
+        void **children = n->type == NODE4 ? ((RadixNode4*)n)->children : ((RadixNode16*)n)->children;
+        if (*pos >= n->num_children) return NULL;
+        *c = keys[*pos];
+        return children[(*pos)++];
+    }
+    case NODE48: {
+        RadixNode48 *p = (RadixNode48*)n;
+        for (; *pos < 256; (*pos)++) {
+            if (p->index[*pos]) {
+                *c = *pos;
+                return p->children[p->index[(*pos)++] - 1];
+            }
+        }
+        break;
+    }
+    case NODE256: {
+        RadixNode256 *p = (RadixNode256*)n;
+        for (; *pos < 256; (*pos)++) {
+            if (p->children[*pos]) {
+                *c = *pos;
+                return p->children[(*pos)++];
+            }
+        }
+        break;
+    }
+    }
+    return NULL;
+}
+
+/* Smallest leaf below x; its key holds the full (uncompressed) path */
+static RadixLeaf* min_leaf(void *x) {
+    while (!IS_LEAF(x)) {
+        RadixNode *n = x;
+        if (n->leaf) return n->leaf;
+
+        int pos = 0;
+        unsigned char c;
+        x = next_child(n, &pos, &c);
+    }
+    return TO_LEAF(x);
+}
+
+/* Number of prefix bytes of n matching key from depth on */
+static size_t prefix_mismatch(RadixNode *n, stringv key, size_t depth) {
+    size_t max = MIN((size_t)n->prefix_len, key.len - depth);
+    size_t stored = MIN(max, (size_t)RADIX_MAX_PREFIX);
+    size_t i = 0;
+
+    for (; i < stored; i++) {
+        if (n->prefix[i] != (unsigned char)key.p[depth + i]) return i;
+    }
+    if (i < max) {
+        /* Prefix is longer than what fits in the node, read it off a leaf */
+        RadixLeaf *leaf = min_leaf(n);
+        for (; i < max; i++) {
+            if (leaf->key[depth + i] != key.p[depth + i]) return i;
+        }
+    }
+    return i;
+}
+
+/* Hang a leaf off a fresh node whose path ends at depth */
+static void place_leaf(RadixPool *pool, RadixNode *n, RadixLeaf *leaf, size_t depth) {
+    if (leaf->len == depth) {
+        n->leaf = leaf;
+    } else {
+        void *ref = n;
+        add_child(pool, &ref, n, leaf->key[depth], MAKE_LEAF(leaf));
+    }
+}
+
+/* Insert */
+
+static int insert_rec(RadixTree *tree, void **ref, stringv key, size_t depth, void *value) {
+    RadixPool *pool = &tree->pool;
+    void *x = *ref;
+
+    if (!x) {
+        RadixLeaf *leaf = leaf_new(pool, key, value);
+        if (!leaf) return 0;
+        *ref = MAKE_LEAF(leaf);
+        tree->num_items++;
+        return 1;
+    }
+
+    if (IS_LEAF(x)) {
+        RadixLeaf *old = TO_LEAF(x);
+        if (old->len == key.len && memcmp(old->key, key.p, key.len) == 0) {
+            old->value = value;
+            return 1;
+        }
+
+        /* Split the leaf into a Node4 holding the common prefix */
+        RadixNode *n = node_new(pool, NODE4);
+        if (!n) return 0;
+        RadixLeaf *leaf = leaf_new(pool, key, value);
+        if (!leaf) {
+            node_free(pool, n);
+            return 0;
+        }
+
+        size_t limit = MIN(old->len, key.len);
+        size_t lcp = 0;
+        while (depth + lcp < limit && old->key[depth + lcp] == key.p[depth + lcp]) {
+            lcp++;
+        }
+        n->prefix_len = lcp;
+        memcpy(n->prefix, key.p + depth, MIN(lcp, (size_t)RADIX_MAX_PREFIX));
+
+        place_leaf(pool, n, old, depth + lcp);
+        place_leaf(pool, n, leaf, depth + lcp);
+        *ref = n;
+        tree->num_items++;
+        return 1;
+    }
+
+    RadixNode *n = x;
+    if (n->prefix_len) {
+        size_t p = prefix_mismatch(n, key, depth);
+        if (p < n->prefix_len) {
+            /* Key diverges inside the prefix: split it at p */
+            RadixNode *parent = node_new(pool, NODE4);
+            if (!parent) return 0;
+            RadixLeaf *leaf = leaf_new(pool, key, value);
+            if (!leaf) {
+                node_free(pool, parent);
+                return 0;
+            }
+
+            parent->prefix_len = p;
+            memcpy(parent->prefix, n->prefix, MIN(p, (size_t)RADIX_MAX_PREFIX));
+
+            unsigned char branch;
+            if (n->prefix_len <= RADIX_MAX_PREFIX) {
+                branch = n->prefix[p];
+                n->prefix_len -= p + 1;
+                memmove(n->prefix, n->prefix + p + 1, n->prefix_len);
+            } else {
+                RadixLeaf *min = min_leaf(n);
+                branch = min->key[depth + p];
+                n->prefix_len -= p + 1;
+                memcpy(n->prefix, min->key + depth + p + 1,
+                       MIN((size_t)n->prefix_len, (size_t)RADIX_MAX_PREFIX));
+            }
+
+            void *parent_ref = parent;
+            add_child(pool, &parent_ref, parent, branch, n);
+            place_leaf(pool, parent, leaf, depth + p);
+            *ref = parent;
+            tree->num_items++;
+            return 1;
+        }
+        depth += n->prefix_len;
+    }
+
+    if (depth == key.len) {
+        if (n->leaf) {
+            n->leaf->value = value;
+            return 1;
+        }
+        n->leaf = leaf_new(pool, key, value);
+        if (!n->leaf) return 0;
+        tree->num_items++;
+        return 1;
+    }
+
+    void **child = find_child(n, key.p[depth]);
+    if (child) {
+        return insert_rec(tree, child, key, depth + 1, value);
+    }
+
+    RadixLeaf *leaf = leaf_new(pool, key, value);
+    if (!leaf) return 0;
+    if (!add_child(pool, ref, n, key.p[depth], MAKE_LEAF(leaf))) return 0;
+    tree->num_items++;
+    return 1;
+}
+
+/* Iteration */
+
+typedef struct {
+    stringv lo;
+    stringv hi;
+    RadixIterFunc func;
+    void *data;
+    int stopped;
+} RadixRange;
+
+static int sv_cmp(stringv a, stringv b) {
+    size_t n = MIN(a.len, b.len);
+    int c = n ? memcmp(a.p, b.p, n) : 0;
+    if (c) return c;
+    return a.len < b.len ? -1 : a.len > b.len;
+}
+
+/*
+ * Returns 1 once the walk is done (hi reached or callback stopped).
+ * check_lo/check_hi are cleared as soon as a subtree is known to lie
+ * entirely inside the bound; while set, the path so far equals the
+ * bound's first depth bytes.
+ */
+static int range_walk(void *x, size_t depth, RadixRange *r, int check_lo, int check_hi) {
+    if (IS_LEAF(x)) {
+        RadixLeaf *leaf = TO_LEAF(x);
+        stringv key = sv_from_parts(leaf->key, leaf->len);
+        if (check_lo && sv_cmp(key, r->lo) < 0) return 0;
+        if (check_hi && sv_cmp(key, r->hi) >= 0) return 1;
+        if (r->func(r->data, key, leaf->value)) {
+            r->stopped = 1;
+            return 1;
+        }
+        return 0;
+    }
+
+    RadixNode *n = x;
+    size_t end = depth + n->prefix_len;
+
+    if (check_lo || check_hi) {
+        /* All keys below n share path[0..end) */
+        const char *path = min_leaf(n)->key;
+        if (check_lo) {
+            size_t m = MIN(end, r->lo.len);
+            int c = m > depth ? memcmp(path + depth, r->lo.p + depth, m - depth) : 0;
+            if (c < 0) return 0;
+            if (c > 0 || end >= r->lo.len) check_lo = 0;
+        }
+        if (check_hi) {
+            size_t m = MIN(end, r->hi.len);
+            int c = m > depth ? memcmp(path + depth, r->hi.p + depth, m - depth) : 0;
+            if (c > 0 || (c == 0 && end >= r->hi.len)) return 1;
+            if (c < 0) check_hi = 0;
+        }
+    }
+
+    if (n->leaf && range_walk(MAKE_LEAF(n->leaf), end, r, check_lo, check_hi)) {
+        return 1;
+    }
+
+    int pos = 0;
+    unsigned char c;
+    void *child;
+    while ((child = next_child(n, &pos, &c))) {
+        int child_lo = check_lo, child_hi = check_hi;
+        if (check_lo) {
+            unsigned char b = r->lo.p[end];
+            if (c < b) continue;
+            if (c > b) child_lo = 0;
+        }
+        if (check_hi) {
+            unsigned char b = r->hi.p[end];
+            if (c > b) return 1;
+            if (c < b) child_hi = 0;
+        }
+        if (range_walk(child, end + 1, r, child_lo, child_hi)) return 1;
+    }
+    return 0;
+}
+
+/* Public API */
+
+RadixTree* radix_new(void) {
+    return calloc(1, sizeof(RadixTree));
+}
+
+void radix_destroy(RadixTree *tree) {
+    if (!tree) return;
+
+    pool_destroy(&tree->pool);
+    free(tree);
+}
+
+int radix_insert(RadixTree *tree, stringv key, void *value) {
+    if (!tree) return 0;
+    return insert_rec(tree, &tree->root, key, 0, value);
+}
+
+void* radix_lookup(RadixTree *tree, stringv key) {
+    if (!tree) return NULL;
+
+    void *x = tree->root;
+    size_t depth = 0;
+
+    /* Prefixes are only checked up to RADIX_MAX_PREFIX; the leaf compare settles it */
+    while (x) {
+        if (IS_LEAF(x)) {
+            RadixLeaf *leaf = TO_LEAF(x);
+            if (leaf->len == key.len && memcmp(leaf->key, key.p, key.len) == 0) {
+                return leaf->value;
+            }
+            return NULL;
+        }
+
+        RadixNode *n = x;
+        if (n->prefix_len) {
+            if (key.len - depth < n->prefix_len) return NULL;
+            size_t stored = MIN((size_t)n->prefix_len, (size_t)RADIX_MAX_PREFIX);
+            if (memcmp(n->prefix, key.p + depth, stored) != 0) return NULL;
+            depth += n->prefix_len;
+        }
+
+        if (depth == key.len) {
+            RadixLeaf *leaf = n->leaf;
+            if (leaf && memcmp(leaf->key, key.p, key.len) == 0) return leaf->value;
+            return NULL;
+        }
+
+        void **child = find_child(n, key.p[depth]);
+        if (!child) return NULL;
+        x = *child;
+        depth++;
+    }
+
+    return NULL;
+}
+
+int radix_contains(RadixTree *tree, stringv key) {
+    return radix_lookup(tree, key) != NULL;
+}
+
+size_t radix_size(RadixTree *tree) {
+    return tree ? tree->num_items : 0;
+}
+
+void* radix_longest_prefix(RadixTree *tree, stringv sv, size_t *match_len) {
+    if (!tree) return NULL;
+
+    RadixLeaf *best = NULL;
+    void *x = tree->root;
+    size_t depth = 0;
+
+    while (x) {
+        if (IS_LEAF(x)) {
+            RadixLeaf *leaf = TO_LEAF(x);
+            if (leaf->len <= sv.len &&
+                memcmp(leaf->key + depth, sv.p + depth, leaf->len - depth) == 0) {
+                best = leaf;
+            }
+            break;
+        }
+
+        RadixNode *n = x;
+        if (n->prefix_len) {
+            if (prefix_mismatch(n, sv, depth) != n->prefix_len) break;
+            depth += n->prefix_len;
+        }
+        if (n->leaf) best = n->leaf;
+        if (depth == sv.len) break;
+
+        void **child = find_child(n, sv.p[depth]);
+        if (!child) break;
+        x = *child;
+        depth++;
+    }
+
+    if (!best) return NULL;
+    if (match_len) *match_len = best->len;
+    return best->value;
+}
+
+int radix_iter(RadixTree *tree, RadixIterFunc func, void *data) {
+    if (!tree || !tree->root) return 0;
+
+    RadixRange r = {0};
+    r.func = func;
+    r.data = data;
+    range_walk(tree->root, 0, &r, 0, 0);
+    return r.stopped;
+}
+
+int radix_iter_range(RadixTree *tree, stringv lo, stringv hi,
+                     RadixIterFunc func, void *data) {
+    if (!tree || !tree->root) return 0;
+
+    RadixRange r = {0};
+    r.lo = lo;
+    r.hi = hi;
+    r.func = func;
+    r.data = data;
+    range_walk(tree->root, 0, &r, lo.len > 0, hi.p != NULL);
+    return r.stopped;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ma.h"
+
+/*
+ * Adaptive radix tree (ART) keyed by stringv.
+ * Inner nodes grow through 4/16/48/256 children and compress common
+ * prefixes; leaves hold a private copy of the key. All nodes and leaves
+ * are carved out of a per-tree pool and released together on destroy.
+ */
+
+#define RADIX_MAX_PREFIX 10
+#define RADIX_POOL_BLOCK (64 * 1024)
+
+typedef struct _RadixLeaf {
+    void *value;
+    size_t len;
+    char key[];
+} RadixLeaf;
+
+typedef struct _RadixPoolBlock {
+    struct _RadixPoolBlock *next;
+} RadixPoolBlock;
+
+typedef struct _RadixPool {
+    RadixPoolBlock *blocks;
+    char *cur;
+    size_t left;
+    void *free_nodes[4];    /* recycled inner nodes, one list per node type */
+} RadixPool;
+
+typedef struct _RadixTree {
+    void *root;
+    size_t num_items;
+    RadixPool pool;
+} RadixTree;
+
+/* Return non-zero to stop the iteration */
+typedef int (*RadixIterFunc)(void *data, stringv key, void *value);
+
+/* Core functions */
+RadixTree* radix_new(void);
+void radix_destroy(RadixTree *tree);
+int radix_insert(RadixTree *tree, stringv key, void *value);
+void* radix_lookup(RadixTree *tree, stringv key);
+int radix_contains(RadixTree *tree, stringv key);
+size_t radix_size(RadixTree *tree);
+
+/* Value of the longest stored key that is a prefix of sv, NULL if none */
+void* radix_longest_prefix(RadixTree *tree, stringv sv, size_t *match_len);
+
+/* In-order walks; a NULL hi.p means no upper bound. Range is [lo, hi) */
+int radix_iter(RadixTree *tree, RadixIterFunc func, void *data);
+int radix_iter_range(RadixTree *tree, stringv lo, stringv hi,
+                     RadixIterFunc func, void *data);
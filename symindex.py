@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+"""
+Persistent symbol index for C/C++ headers, shared by coogle.py and list_funcs.py
+Functions (via libclang) and function-like macros (via regex) are cached on
+disk per header, keyed by mtime/size and falling back to a content hash, so
+only new or changed headers are re-parsed. Stale headers are parsed in
+parallel worker processes.
+
+Cache location: $COOGLE_CACHE or ~/.cache/coogle/index.json
+Worker count:   $COOGLE_JOBS or os.cpu_count()
+"""
+
+import hashlib
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+from concurrent.futures import ProcessPoolExecutor
+from pathlib import Path
+
+CACHE_VERSION = 1
+CLANG_ARGS = ['-x', 'c++']
+HEADER_SUFFIXES = ('.h', '.hh', '.hpp', '.hxx')
+MACRO_PATTERN = re.compile(r'#define\s+([A-Za-z_][A-Za-z0-9_]*)\s*\(([^)]*)\)')
+
+def default_cache_path():
+    env = os.environ.get('COOGLE_CACHE')
+    if env:
+        return Path(env)
+    base = os.environ.get('XDG_CACHE_HOME') or Path.home() / '.cache'
+    return Path(base) / 'coogle' / 'index.json'
+
+def normalize_type(type_str):
+    """Normalize type string for comparison"""
+    # Remove const
+    type_str = type_str.replace('const', '').strip()
+    # Normalize whitespace around asterisks for pointer types
+    type_str = type_str.replace('*', ' * ')
+    # Normalize whitespace
+    type_str = ' '.join(type_str.split())
+    # Case insensitive
+    type_str = type_str.lower()
+    return type_str
+
+def collect_headers(paths):
+    """Expand files and directories into a sorted list of header paths"""
+    headers = set()
+    for path in paths:
+        path = Path(path)
+        if path.is_dir():
+            for child in path.rglob('*'):
+                if child.is_file() and child.suffix in HEADER_SUFFIXES:
+                    headers.add(child.resolve())
+        elif path.exists():
+            headers.add(path.resolve())
+    return sorted(headers)
+
+def file_digest(path):
+    h = hashlib.sha1()
+    with open(path, 'rb') as f:
+        for chunk in iter(lambda: f.read(1 << 16), b''):
+            h.update(chunk)
+    return h.hexdigest()
+
+def parse_functions(header_path):
+    """Parse C/C++ header and extract functions using clang"""
+    import clang.cindex
+
+    index = clang.cindex.Index.create()
+    translation_unit = index.parse(str(header_path), args=CLANG_ARGS)
+
+    functions = []
+
+    def visit_node(node):
+        """Recursively visit AST nodes"""
+
+        if node.location.file and str(node.location.file) == str(header_path):
+
+            if node.kind == clang.cindex.CursorKind.FUNCTION_DECL:
+                func_name = node.spelling
+
+                # Get parameters
+                param_types = []
+                params = []
+                for arg in node.get_arguments():
+                    param_types.append(normalize_type(arg.type.spelling))
+                    param_name = arg.spelling or ""
+                    params.append(f"{arg.type.spelling} {param_name}".strip())
+
+                param_str = ", ".join(params) if params else "void"
+
+                functions.append({
+                    'name': func_name,
+                    'type': 'function',
+                    'return_type': normalize_type(node.result_type.spelling),
+                    'param_types': param_types,
+                    'signature': f"{node.result_type.spelling} {func_name}({param_str})",
+                    'line': node.location.line
+                })
+
+        for child in node.get_children():
+            visit_node(child)
+
+    visit_node(translation_unit.cursor)
+    return functions
+
+def parse_macros(header_path):
+    """Parse function-like macros from header file"""
+
+    macros = []
+
+    try:
+        with open(header_path, 'r', encoding='utf-8') as f:
+            content = f.read()
+
+        for line_num, line in enumerate(content.split('\n'), 1):
+            match = MACRO_PATTERN.search(line)
+            if match:
+                macro_name = match.group(1)
+                params = match.group(2).strip()
+                macros.append({
+                    'name': macro_name,
+                    'type': 'macro',
+                    'signature': f"#define {macro_name}({params})",
+                    'line': line_num
+                })
+
+    except Exception as e:
+        print(f"Warning: Could not parse macros in {header_path}: {e}", file=sys.stderr)
+
+    return macros
+
+def parse_header(header_path):
+    """Worker entry point: parse one header into a cache entry"""
+    st = os.stat(header_path)
+    return str(header_path), {
+        'mtime_ns': st.st_mtime_ns,
+        'size': st.st_size,
+        'sha1': file_digest(header_path),
+        'functions': parse_functions(header_path),
+        'macros': parse_macros(header_path),
+    }
+
+class SymbolIndex:
+    """Cached functions and macros for a set of headers, plus a type index"""
+
+    def __init__(self, cache_path=None):
+        self.cache_path = Path(cache_path) if cache_path else default_cache_path()
+        self.entries = {}
+        self.dirty = False
+        self._load()
+
+    def _load(self):
+        try:
+            with open(self.cache_path, 'r', encoding='utf-8') as f:
+                data = json.load(f)
+        except (OSError, ValueError):
+            return
+        if data.get('version') != CACHE_VERSION or data.get('clang_args') != CLANG_ARGS:
+            return
+        self.entries = data.get('files', {})
+
+    def save(self):
+        if not self.dirty:
+            return
+        self.cache_path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = self.cache_path.with_name(self.cache_path.name + f'.{os.getpid()}.tmp')
+        with open(tmp, 'w', encoding='utf-8') as f:
+            json.dump({
+                'version': CACHE_VERSION,
+                'clang_args': CLANG_ARGS,
+                'files': self.entries,
+            }, f)
+        os.replace(tmp, self.cache_path)
+        self.dirty = False
+
+    def _is_fresh(self, header_path):
+        entry = self.entries.get(str(header_path))
+        if entry is None:
+            return False
+        st = os.stat(header_path)
+        if entry['mtime_ns'] == st.st_mtime_ns and entry['size'] == st.st_size:
+            return True
+        # Touched but maybe not modified: compare contents before re-parsing
+        if entry['size'] == st.st_size and entry['sha1'] == file_digest(header_path):
+            entry['mtime_ns'] = st.st_mtime_ns
+            self.dirty = True
+            return True
+        return False
+
+    def update(self, headers, jobs=None):
+        """Re-parse stale headers (in parallel) and return the number parsed"""
+        stale = [h for h in headers if not self._is_fresh(h)]
+        if not stale:
+            return 0
+        if jobs is None:
+            jobs = int(os.environ.get('COOGLE_JOBS', 0)) or os.cpu_count() or 1
+        jobs = min(jobs, len(stale))
+        if jobs <= 1:
+            results = list(map(parse_header, stale))
+        else:
+            chunksize = max(1, len(stale) // (jobs * 4))
+            with ProcessPoolExecutor(max_workers=jobs) as executor:
+                results = list(executor.map(parse_header, stale, chunksize=chunksize))
+        for path, entry in results:
+            self.entries[path] = entry
+        self.dirty = True
+        return len(stale)
+
+    def items(self, headers, kinds=('functions', 'macros')):
+        """All cached records for the given headers, tagged with their file"""
+        result = []
+        for header in headers:
+            entry = self.entries.get(str(header))
+            if entry is None:
+                continue
+            for kind in kinds:
+                for item in entry[kind]:
+                    result.append(dict(item, file=str(header)))
+        return result
+
+def load_index(paths, jobs=None, cache_path=None):
+    """Resolve headers under paths, refresh the cache and return (headers, index)"""
+    headers = collect_headers(paths)
+    index = SymbolIndex(cache_path)
+    index.update(headers, jobs)
+    try:
+        index.save()
+    except OSError as e:
+        print(f"Warning: Could not write symbol cache {index.cache_path}: {e}", file=sys.stderr)
+    return headers, index
+
+class TypeIndex:
+    """
+    Inverted index from normalized type string to function ids.
+    Queries match by substring, so a term is resolved against the (small)
+    vocabulary of distinct types instead of every function's signature.
+    """
+
+    def __init__(self, functions):
+        self.functions = functions
+        self.by_return = defaultdict(set)
+        self.by_param = defaultdict(set)
+        for i, func in enumerate(functions):
+            self.by_return[func['return_type']].add(i)
+            for ptype in func['param_types']:
+                self.by_param[ptype].add(i)
+        self._cache = {}
+
+    def _lookup(self, postings, which, term):
+        key = (which, term)
+        hit = self._cache.get(key)
+        if hit is None:
+            hit = set()
+            for type_str, ids in postings.items():
+                if term in type_str:
+                    hit |= ids
+            self._cache[key] = hit
+        return hit
+
+    def returning(self, term):
+        return self._lookup(self.by_return, 'ret', term)
+
+    def taking(self, term):
+        return self._lookup(self.by_param, 'param', term)
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "radix.h"
+#include <assert.h>
+
+#define SV(s) sv_from_cstr(s)
+
+typedef struct {
+    char keys[1024][32];
+    int count;
+    int limit;
+} Collected;
+
+static int collect(void *data, stringv key, void *value) {
+    Collected *c = data;
+    (void)value;
+    assert(key.len < 32);
+    memcpy(c->keys[c->count], key.p, key.len);
+    c->keys[c->count][key.len] = '\0';
+    c->count++;
+    return c->limit && c->count == c->limit;
+}
+
+static int cmp_cstr(const void *a, const void *b) {
+    return strcmp(*(char *const*)a, *(char *const*)b);
+}
+
+void test_basic_radix() {
+    RadixTree *tree = radix_new();
+    assert(tree != NULL);
+
+    // Insert, including keys that are prefixes of each other
+    assert(radix_insert(tree, SV("apple"), "fruit"));
+    assert(radix_insert(tree, SV("app"), "short"));
+    assert(radix_insert(tree, SV("application"), "long"));
+    assert(radix_insert(tree, SV("banana"), "fruit"));
+    assert(radix_insert(tree, SV(""), "empty"));
+    assert(radix_size(tree) == 5);
+
+    // Replace keeps the size
+    assert(radix_insert(tree, SV("app"), "replaced"));
+    assert(radix_size(tree) == 5);
+
+    // Lookup
+    assert(strcmp(radix_lookup(tree, SV("apple")), "fruit") == 0);
+    assert(strcmp(radix_lookup(tree, SV("app")), "replaced") == 0);
+    assert(strcmp(radix_lookup(tree, SV("application")), "long") == 0);
+    assert(strcmp(radix_lookup(tree, SV("")), "empty") == 0);
+    assert(radix_lookup(tree, SV("ap")) == NULL);
+    assert(radix_lookup(tree, SV("apples")) == NULL);
+    assert(radix_lookup(tree, SV("applicatiom")) == NULL);
+    assert(!radix_contains(tree, SV("orange")));
+
+    radix_destroy(tree);
+}
+
+void test_longest_prefix_radix() {
+    RadixTree *tree = radix_new();
+    char *routes[] = {"/", "/api", "/api/v1/", "/api/v1/users", "/static/"};
+    for (size_t i = 0; i < SIZEOF(routes); i++) {
+        assert(radix_insert(tree, SV(routes[i]), routes[i]));
+    }
+
+    size_t len = 0;
+    assert(strcmp(radix_longest_prefix(tree, SV("/api/v1/users/42"), &len), "/api/v1/users") == 0);
+    assert(len == strlen("/api/v1/users"));
+    assert(strcmp(radix_longest_prefix(tree, SV("/api/v1/"), &len), "/api/v1/") == 0);
+    assert(strcmp(radix_longest_prefix(tree, SV("/api/v2"), &len), "/api") == 0);
+    assert(strcmp(radix_longest_prefix(tree, SV("/static"), &len), "/") == 0);
+    assert(strcmp(radix_longest_prefix(tree, SV("/static/app.js"), &len), "/static/") == 0);
+    assert(radix_longest_prefix(tree, SV("api"), &len) == NULL);
+
+    // Long compressed prefixes spill past RADIX_MAX_PREFIX
+    assert(radix_insert(tree, SV("/very/long/shared/path/a"), "a"));
+    assert(radix_insert(tree, SV("/very/long/shared/path/b"), "b"));
+    assert(strcmp(radix_longest_prefix(tree, SV("/very/long/shared/path/b/c"), NULL), "b") == 0);
+    assert(strcmp(radix_longest_prefix(tree, SV("/very/long/shared/pa"), NULL), "/") == 0);
+    assert(strcmp(radix_longest_prefix(tree, SV("/very/long/shared/XXth/a"), NULL), "/") == 0);
+
+    radix_destroy(tree);
+}
+
+void test_ordered_iter_radix() {
+    RadixTree *tree = radix_new();
+    static char storage[600][16];
+    char *sorted[600];
+
+    // Enough fan-out under "k" to grow through Node16/48/256
+    int n = 0;
+    for (int i = 0; i < 600; i++) {
+        snprintf(storage[n], sizeof(storage[n]), "k%c%d", (i * 7) % 250 + 1, i);
+        assert(radix_insert(tree, SV(storage[n]), storage[n]));
+        sorted[n] = storage[n];
+        n++;
+    }
+    assert(radix_size(tree) == 600);
+    qsort(sorted, n, sizeof(char*), cmp_cstr);
+
+    for (int i = 0; i < n; i++) {
+        assert(radix_lookup(tree, SV(sorted[i])) == sorted[i]);
+    }
+
+    // Full walk is in byte order
+    Collected *c = calloc(1, sizeof(Collected));
+    assert(radix_iter(tree, collect, c) == 0);
+    assert(c->count == n);
+    for (int i = 0; i < n; i++) {
+        assert(strcmp(c->keys[i], sorted[i]) == 0);
+    }
+
+    // Range [sorted[100], sorted[250])
+    memset(c, 0, sizeof(*c));
+    radix_iter_range(tree, SV(sorted[100]), SV(sorted[250]), collect, c);
+    assert(c->count == 150);
+    for (int i = 0; i < 150; i++) {
+        assert(strcmp(c->keys[i], sorted[100 + i]) == 0);
+    }
+
+    // Bounds that are not keys themselves, and an open upper bound
+    memset(c, 0, sizeof(*c));
+    stringv open = {0};
+    radix_iter_range(tree, SV("k\x80"), open, collect, c);
+    int first = 0;
+    while (strcmp(sorted[first], "k\x80") < 0) first++;
+    assert(c->count == n - first);
+
+    // Early stop
+    memset(c, 0, sizeof(*c));
+    c->limit = 3;
+    assert(radix_iter(tree, collect, c) == 1);
+    assert(c->count == 3);
+
+    free(c);
+    radix_destroy(tree);
+}
+
+int main()
+{
+    test_basic_radix();
+    test_longest_prefix_radix();
+    test_ordered_iter_radix();
+
+    printf("radix tests passed\n");
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utf8.h"
+#include <assert.h>
+
+#define SV(s) sv_from_cstr(s)
+
+static const char *kernel_names[] = {"avx2", "ssse3", "scalar"};
+
+/* Reference: decode one codepoint at a time */
+static bool validate_reference(const char *p, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        uint32_t cp;
+        size_t n = utf8_decode(p + i, len - i, &cp);
+        if (n == 0) return false;
+        i += n;
+    }
+    return true;
+}
+
+void test_validate_utf8() {
+    char *valid[] = {
+        "", "plain ascii", "caf\xc3\xa9", "\xe2\x82\xac 100", "\xf0\x9f\x98\x80",
+        "\xed\x9f\xbf", "\xee\x80\x80", "\xf4\x8f\xbf\xbf", "\xef\xbb\xbf" "bom",
+    };
+    char *invalid[] = {
+        "\x80", "\xbf", "\xc0\xaf", "\xc1\xbf", "\xc3", "\xe2\x82", "\xe0\x80\xaf",
+        "\xed\xa0\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",
+        "\xff", "\xc3\xa9\xa9", "\xf0\x9f\x98",
+    };
+
+    for (size_t k = 0; k < SIZEOF(kernel_names); k++) {
+        if (!utf8_use_kernel(kernel_names[k])) continue;
+
+        for (size_t i = 0; i < SIZEOF(valid); i++) {
+            assert(utf8_validate(valid[i], strlen(valid[i])));
+        }
+
+        // Every invalid sequence at every offset across block boundaries
+        char buf[128];
+        for (size_t i = 0; i < SIZEOF(invalid); i++) {
+            size_t n = strlen(invalid[i]);
+            for (size_t off = 0; off + n <= 80; off++) {
+                memset(buf, 'a', sizeof(buf));
+                memcpy(buf + off, invalid[i], n);
+                assert(!utf8_validate(buf, off + n));
+                assert(!utf8_validate(buf, 100));
+            }
+        }
+
+        // Truncated at the very end of a full block
+        memset(buf, 'a', sizeof(buf));
+        memcpy(buf + 62, "\xf0\x9f", 2);
+        assert(!utf8_validate(buf, 64));
+        memcpy(buf + 62, "\xf0\x9f\x98\x80", 4);
+        assert(utf8_validate(buf, 66));
+    }
+
+    // Random byte soup agrees with the reference decoder
+    srand(1);
+    char soup[200];
+    static const unsigned char alphabet[] = {'a', 0x80, 0x9f, 0xa0, 0xbf, 0xc2, 0xdf,
+                                             0xe0, 0xed, 0xef, 0xf0, 0xf4, 0xf5};
+    for (int iter = 0; iter < 20000; iter++) {
+        size_t len = rand() % sizeof(soup);
+        for (size_t i = 0; i < len; i++) {
+            soup[i] = rand() % 4 ? 'a' : alphabet[rand() % sizeof(alphabet)];
+        }
+        bool expected = validate_reference(soup, len);
+        for (size_t k = 0; k < SIZEOF(kernel_names); k++) {
+            if (!utf8_use_kernel(kernel_names[k])) continue;
+            assert(utf8_validate(soup, len) == expected);
+        }
+    }
+
+    utf8_use_kernel(NULL);
+}
+
+void test_count_utf8() {
+    char text[4096];
+    size_t len = 0, codepoints = 0;
+    char *pieces[] = {"a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+    srand(2);
+    while (len + 4 < sizeof(text)) {
+        char *piece = pieces[rand() % 4];
+        memcpy(text + len, piece, strlen(piece));
+        len += strlen(piece);
+        codepoints++;
+    }
+
+    for (size_t k = 0; k < SIZEOF(kernel_names); k++) {
+        if (!utf8_use_kernel(kernel_names[k])) continue;
+        assert(utf8_validate(text, len));
+        assert(utf8_count(text, len) == codepoints);
+        assert(utf8_count(text + 1, 0) == 0);
+        assert(utf8_ascii_prefix("abc\xc3\xa9", 5) == 3);
+    }
+    utf8_use_kernel(NULL);
+
+    assert(sv_utf8_len(SV("caf\xc3\xa9")) == 4);
+    assert(sv_utf8_valid(SV("caf\xc3\xa9")));
+    assert(!sv_utf8_valid(SV("caf\xc3")));
+}
+
+void test_chop_utf8() {
+    stringv sv = SV("h\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80!");
+    assert(sv_utf8_chop_codepoint(&sv) == 'h');
+    assert(sv_utf8_chop_codepoint(&sv) == 0xE9);
+    assert(sv_utf8_chop_codepoint(&sv) == 0x20AC);
+    assert(sv_utf8_chop_codepoint(&sv) == 0x1F600);
+    assert(sv_utf8_chop_codepoint(&sv) == '!');
+    assert(sv.len == 0);
+
+    sv = SV("\xff" "a");
+    assert(sv_utf8_chop_codepoint(&sv) == UTF8_REPLACEMENT);
+    assert(sv_utf8_chop_codepoint(&sv) == 'a');
+
+    // Chopping by codepoints, long enough to go through the chunked path
+    char text[300];
+    for (int i = 0; i < 100; i++) memcpy(text + i * 3, "\xe2\x82\xac", 3);
+    sv = sv_from_parts(text, sizeof(text));
+    stringv head = sv_utf8_chop_left(&sv, 70);
+    assert(head.len == 210);
+    assert(sv.len == 90);
+    head = sv_utf8_chop_left(&sv, 1000);
+    assert(head.len == 90);
+    assert(sv.len == 0);
+}
+
+void test_trim_width_utf8() {
+    stringv sv = sv_utf8_trim(SV("\xe3\x80\x80\t \xc2\xa0h\xc3\xa9llo\xe2\x80\x83\n"));
+    assert(sv_eq(sv, SV("h\xc3\xa9llo")));
+    assert(sv_utf8_trim(SV(" \xc2\xa0 ")).len == 0);
+    // A dangling lead byte is not whitespace
+    assert(sv_utf8_trim_right(SV("a\xc2")).len == 2);
+
+    assert(sv_utf8_width(SV("hello")) == 5);
+    assert(sv_utf8_width(SV("\xe6\x97\xa5\xe6\x9c\xac")) == 4);
+    assert(sv_utf8_width(SV("e\xcc\x81")) == 1);
+    assert(sv_utf8_width(SV("\xf0\x9f\x98\x80!")) == 3);
+    assert(sv_utf8_width(SV("a\tb")) == 2);
+}
+
+int main()
+{
+    printf("utf8 kernel: %s\n", utf8_kernel());
+
+    test_validate_utf8();
+    test_count_utf8();
+    test_chop_utf8();
+    test_trim_width_utf8();
+
+    printf("utf8 tests passed\n");
+
+    return 0;
+}
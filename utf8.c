@@ -0,0 +1,594 @@
+#include "utf8.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UTF8_X86 1
+#include <immintrin.h>
+#endif
+
+#define IS_CONT(c) (((unsigned char)(c) & 0xC0) == 0x80)
+
+/* Scalar */
+
+size_t utf8_decode(const char *p, size_t len, uint32_t *cp) {
+  const unsigned char *s = (const unsigned char *)p;
+  if (len == 0) {
+    return 0;
+  }
+
+  unsigned char c = s[0];
+  if (c < 0x80) {
+    *cp = c;
+    return 1;
+  }
+
+  size_t n;
+  uint32_t value;
+  if (c >= 0xC2 && c <= 0xDF) {
+    n = 2;
+    value = c & 0x1F;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    n = 3;
+    value = c & 0x0F;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    n = 4;
+    value = c & 0x07;
+  } else {
+    return 0;
+  }
+  if (len < n) {
+    return 0;
+  }
+
+  /* Second byte range excludes overlongs, surrogates and > U+10FFFF */
+  unsigned char lo = 0x80, hi = 0xBF;
+  if (c == 0xE0) lo = 0xA0;
+  if (c == 0xED) hi = 0x9F;
+  if (c == 0xF0) lo = 0x90;
+  if (c == 0xF4) hi = 0x8F;
+  if (s[1] < lo || s[1] > hi) {
+    return 0;
+  }
+
+  for (size_t i = 1; i < n; i++) {
+    if (!IS_CONT(s[i])) {
+      return 0;
+    }
+    value = (value << 6) | (s[i] & 0x3F);
+  }
+
+  *cp = value;
+  return n;
+}
+
+static size_t ascii_prefix_scalar(const char *p, size_t len) {
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t w;
+    memcpy(&w, p + i, 8);
+    if (w & 0x8080808080808080ULL) {
+      break;
+    }
+  }
+  while (i < len && (unsigned char)p[i] < 0x80) {
+    i += 1;
+  }
+  return i;
+}
+
+static bool validate_scalar(const char *p, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    i += ascii_prefix_scalar(p + i, len - i);
+    if (i == len) {
+      break;
+    }
+
+    uint32_t cp;
+    size_t n = utf8_decode(p + i, len - i, &cp);
+    if (n == 0) {
+      return false;
+    }
+    i += n;
+  }
+  return true;
+}
+
+static size_t count_scalar(const char *p, size_t len) {
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++) {
+    count += !IS_CONT(p[i]);
+  }
+  return count;
+}
+
+#ifdef UTF8_X86
+
+/*
+ * Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per
+ * Byte". Each byte pair is classified through three nibble lookups whose
+ * AND is non-zero for every invalid 2-byte pattern; missing or excess
+ * 3rd/4th continuation bytes are caught by comparing against the lead
+ * bytes two and three positions back.
+ */
+#define TOO_SHORT (1 << 0)
+#define TOO_LONG (1 << 1)
+#define OVERLONG_3 (1 << 2)
+#define TOO_LARGE (1 << 3)
+#define SURROGATE (1 << 4)
+#define OVERLONG_2 (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6)
+#define TWO_CONTS (1 << 7)
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+static const uint8_t byte_1_high[16] = {
+    /* 0xxx: ASCII */
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    /* 10xx: continuation */
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    /* 1100, 1101: 2-byte lead */
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    /* 1110: 3-byte lead */
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    /* 1111: 4-byte lead */
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+static const uint8_t byte_1_low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+static const uint8_t byte_2_high[16] = {
+    /* 0xxx: ASCII */
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    /* 1000, 1001, 101x: continuation */
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    /* 11xx: lead */
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+/* Last bytes of a block that still expect continuations in the next one */
+static const uint8_t incomplete_max[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+/* SSSE3 */
+
+typedef struct {
+  __m128i prev_input;
+  __m128i prev_incomplete;
+  __m128i error;
+} Utf8State128;
+
+__attribute__((target("ssse3"))) static inline void
+check_block_ssse3(Utf8State128 *st, __m128i in) {
+  if (_mm_movemask_epi8(in) == 0) {
+    st->error = _mm_or_si128(st->error, st->prev_incomplete);
+    st->prev_input = in;
+    return;
+  }
+
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  __m128i prev1 = _mm_alignr_epi8(in, st->prev_input, 15);
+  __m128i b1h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_high),
+                                 _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+  __m128i b1l = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_low),
+                                 _mm_and_si128(prev1, nibble));
+  __m128i b2h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_2_high),
+                                 _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+  __m128i special = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+  __m128i prev2 = _mm_alignr_epi8(in, st->prev_input, 14);
+  __m128i prev3 = _mm_alignr_epi8(in, st->prev_input, 13);
+  __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+  __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+  __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+
+  st->error = _mm_or_si128(st->error, _mm_xor_si128(must23, special));
+  st->prev_incomplete = _mm_subs_epu8(in, _mm_loadu_si128((const __m128i *)(incomplete_max + 16)));
+  st->prev_input = in;
+}
+
+__attribute__((target("ssse3"))) static bool validate_ssse3(const char *p, size_t len) {
+  Utf8State128 st = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    check_block_ssse3(&st, _mm_loadu_si128((const __m128i *)(p + i)));
+  }
+
+  /* Zero padding makes a sequence cut off by the end of input an error */
+  char tail[16] = {0};
+  if (len > i) {
+    memcpy(tail, p + i, len - i);
+  }
+  check_block_ssse3(&st, _mm_loadu_si128((const __m128i *)tail));
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(st.error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+__attribute__((target("ssse3"))) static size_t count_ssse3(const char *p, size_t len) {
+  const __m128i cont_max = _mm_set1_epi8((char)0xBF);
+  size_t count = 0, i = 0;
+
+  /* Per-byte counters are flushed through psadbw before they can overflow */
+  while (i + 16 <= len) {
+    __m128i acc = _mm_setzero_si128();
+    size_t end = MIN(len & ~(size_t)15, i + 255 * 16);
+    for (; i < end; i += 16) {
+      __m128i in = _mm_loadu_si128((const __m128i *)(p + i));
+      acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(in, cont_max));
+    }
+    __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+    count += (size_t)_mm_extract_epi16(sums, 0) + (size_t)_mm_extract_epi16(sums, 4);
+  }
+  return count + count_scalar(p + i, len - i);
+}
+
+__attribute__((target("ssse3"))) static size_t ascii_prefix_ssse3(const char *p, size_t len) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(p + i)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ascii_prefix_scalar(p + i, len - i);
+}
+
+/* AVX2 */
+
+typedef struct {
+  __m256i prev_input;
+  __m256i prev_incomplete;
+  __m256i error;
+} Utf8State256;
+
+#define PREV_AVX2(in, prev, n)                                                 \
+  _mm256_alignr_epi8((in), _mm256_permute2x128_si256((prev), (in), 0x21), 16 - (n))
+
+__attribute__((target("avx2"))) static inline __m256i table_avx2(const uint8_t *table) {
+  return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+
+__attribute__((target("avx2"))) static inline void
+check_block_avx2(Utf8State256 *st, __m256i in) {
+  if (_mm256_movemask_epi8(in) == 0) {
+    st->error = _mm256_or_si256(st->error, st->prev_incomplete);
+    st->prev_input = in;
+    return;
+  }
+
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  __m256i prev1 = PREV_AVX2(in, st->prev_input, 1);
+  __m256i b1h = _mm256_shuffle_epi8(table_avx2(byte_1_high),
+                                    _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+  __m256i b1l = _mm256_shuffle_epi8(table_avx2(byte_1_low), _mm256_and_si256(prev1, nibble));
+  __m256i b2h = _mm256_shuffle_epi8(table_avx2(byte_2_high),
+                                    _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+  __m256i special = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+  __m256i prev2 = PREV_AVX2(in, st->prev_input, 2);
+  __m256i prev3 = PREV_AVX2(in, st->prev_input, 3);
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+
+  st->error = _mm256_or_si256(st->error, _mm256_xor_si256(must23, special));
+  st->prev_incomplete = _mm256_subs_epu8(in, _mm256_loadu_si256((const __m256i *)incomplete_max));
+  st->prev_input = in;
+}
+
+__attribute__((target("avx2"))) static bool validate_avx2(const char *p, size_t len) {
+  Utf8State256 st = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    check_block_avx2(&st, _mm256_loadu_si256((const __m256i *)(p + i)));
+  }
+
+  char tail[32] = {0};
+  if (len > i) {
+    memcpy(tail, p + i, len - i);
+  }
+  check_block_avx2(&st, _mm256_loadu_si256((const __m256i *)tail));
+
+  return _mm256_testz_si256(st.error, st.error);
+}
+
+__attribute__((target("avx2"))) static size_t count_avx2(const char *p, size_t len) {
+  const __m256i cont_max = _mm256_set1_epi8((char)0xBF);
+  size_t count = 0, i = 0;
+
+  while (i + 32 <= len) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t end = MIN(len & ~(size_t)31, i + 255 * 32);
+    for (; i < end; i += 32) {
+      __m256i in = _mm256_loadu_si256((const __m256i *)(p + i));
+      acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(in, cont_max));
+    }
+    __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    count += (size_t)_mm_extract_epi16(half, 0) + (size_t)_mm_extract_epi16(half, 4);
+  }
+  return count + count_scalar(p + i, len - i);
+}
+
+__attribute__((target("avx2"))) static size_t ascii_prefix_avx2(const char *p, size_t len) {
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    unsigned mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(p + i)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ascii_prefix_scalar(p + i, len - i);
+}
+
+static bool has_avx2(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+static bool has_ssse3(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+}
+
+#endif /* UTF8_X86 */
+
+/* Dispatch */
+
+typedef struct {
+  const char *name;
+  bool (*supported)(void);
+  bool (*validate)(const char *p, size_t len);
+  size_t (*count)(const char *p, size_t len);
+  size_t (*ascii_prefix)(const char *p, size_t len);
+} Utf8Kernel;
+
+static bool always(void) { return true; }
+
+/* Best first */
+static const Utf8Kernel kernels[] = {
+#ifdef UTF8_X86
+    {"avx2", has_avx2, validate_avx2, count_avx2, ascii_prefix_avx2},
+    {"ssse3", has_ssse3, validate_ssse3, count_ssse3, ascii_prefix_ssse3},
+#endif
+    {"scalar", always, validate_scalar, count_scalar, ascii_prefix_scalar},
+};
+
+static const Utf8Kernel *active_kernel;
+
+const char *utf8_use_kernel(const char *name) {
+  for (size_t i = 0; i < SIZEOF(kernels); i++) {
+    if (name && strcmp(name, kernels[i].name) != 0) {
+      continue;
+    }
+    if (kernels[i].supported()) {
+      active_kernel = &kernels[i];
+      return active_kernel->name;
+    }
+  }
+  return NULL;
+}
+
+static const Utf8Kernel *kernel(void) {
+  if (!active_kernel) {
+    utf8_use_kernel(NULL);
+  }
+  return active_kernel;
+}
+
+const char *utf8_kernel(void) { return kernel()->name; }
+
+bool utf8_validate(const char *p, size_t len) { return kernel()->validate(p, len); }
+
+size_t utf8_count(const char *p, size_t len) { return kernel()->count(p, len); }
+
+size_t utf8_ascii_prefix(const char *p, size_t len) {
+  return kernel()->ascii_prefix(p, len);
+}
+
+/* Codepoint properties */
+
+typedef struct {
+  uint32_t lo, hi;
+} Utf8Range;
+
+/* Combining marks and zero-width format characters (approximate) */
+static const Utf8Range zero_width[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC}, {0x0E31, 0x0E31},
+    {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF},
+    {0x200B, 0x200F}, {0x2028, 0x202E}, {0x2060, 0x2064}, {0x20D0, 0x20FF},
+    {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xE0100, 0xE01EF},
+};
+
+/* East Asian Wide/Fullwidth and emoji presentation blocks */
+static const Utf8Range double_width[] = {
+    {0x1100, 0x115F},   {0x231A, 0x231B},   {0x2329, 0x232A},
+    {0x23E9, 0x23EC},   {0x23F0, 0x23F0},   {0x23F3, 0x23F3},
+    {0x25FD, 0x25FE},   {0x2614, 0x2615},   {0x2E80, 0x303E},
+    {0x3041, 0x33FF},   {0x3400, 0x4DBF},   {0x4E00, 0x9FFF},
+    {0xA000, 0xA4CF},   {0xA960, 0xA97F},   {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF},   {0xFE10, 0xFE19},   {0xFE30, 0xFE6F},
+    {0xFF00, 0xFF60},   {0xFFE0, 0xFFE6},   {0x1F300, 0x1F64F},
+    {0x1F900, 0x1F9FF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+};
+
+static bool in_ranges(const Utf8Range *ranges, size_t n, uint32_t cp) {
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cp < ranges[mid].lo) {
+      hi = mid;
+    } else if (cp > ranges[mid].hi) {
+      lo = mid + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+int utf8_cp_width(uint32_t cp) {
+  if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) {
+    return 0;
+  }
+  if (cp < 0x300) {
+    return 1;
+  }
+  if (in_ranges(zero_width, SIZEOF(zero_width), cp)) {
+    return 0;
+  }
+  if (in_ranges(double_width, SIZEOF(double_width), cp)) {
+    return 2;
+  }
+  return 1;
+}
+
+/* Unicode White_Space, independent of the C locale */
+static bool utf8_is_space(uint32_t cp) {
+  switch (cp) {
+  case 0x09: case 0x0A: case 0x0B: case 0x0C: case 0x0D: case 0x20:
+  case 0x85: case 0xA0: case 0x1680: case 0x2028: case 0x2029:
+  case 0x202F: case 0x205F: case 0x3000:
+    return true;
+  default:
+    return cp >= 0x2000 && cp <= 0x200A;
+  }
+}
+
+/* stringv */
+
+bool sv_utf8_valid(stringv sv) { return utf8_validate(sv.p, sv.len); }
+
+size_t sv_utf8_len(stringv sv) { return utf8_count(sv.p, sv.len); }
+
+uint32_t sv_utf8_chop_codepoint(stringv *sv) {
+  uint32_t cp = UTF8_REPLACEMENT;
+  size_t n = utf8_decode(sv->p, sv->len, &cp);
+  if (n == 0) {
+    /* Invalid byte: consume it alone and report U+FFFD */
+    cp = UTF8_REPLACEMENT;
+    n = MIN(sv->len, (size_t)1);
+  }
+
+  sv->p += n;
+  sv->len -= n;
+  return cp;
+}
+
+stringv sv_utf8_chop_left(stringv *sv, size_t n) {
+  size_t i = 0;
+
+  /* Skip whole chunks with the counting kernel while they hold <= n codepoints */
+  while (sv->len - i >= 64) {
+    size_t c = utf8_count(sv->p + i, 64);
+    if (c > n) {
+      break;
+    }
+    n -= c;
+    i += 64;
+  }
+  for (; i < sv->len; i++) {
+    if (!IS_CONT(sv->p[i])) {
+      if (n == 0) {
+        break;
+      }
+      n -= 1;
+    }
+  }
+
+  return sv_chop_left(sv, i);
+}
+
+stringv sv_utf8_trim_left(stringv sv) {
+  size_t i = 0;
+  while (i < sv.len) {
+    uint32_t cp;
+    size_t n = utf8_decode(sv.p + i, sv.len - i, &cp);
+    if (n == 0 || !utf8_is_space(cp)) {
+      break;
+    }
+    i += n;
+  }
+
+  return sv_from_parts(sv.p + i, sv.len - i);
+}
+
+stringv sv_utf8_trim_right(stringv sv) {
+  size_t end = sv.len;
+  while (end > 0) {
+    /* Step back to the lead byte of the last codepoint */
+    size_t start = end - 1;
+    while (start > 0 && end - start < 4 && IS_CONT(sv.p[start])) {
+      start -= 1;
+    }
+
+    uint32_t cp;
+    size_t n = utf8_decode(sv.p + start, end - start, &cp);
+    if (n != end - start || !utf8_is_space(cp)) {
+      break;
+    }
+    end = start;
+  }
+
+  return sv_from_parts(sv.p, end);
+}
+
+stringv sv_utf8_trim(stringv sv) { return sv_utf8_trim_right(sv_utf8_trim_left(sv)); }
+
+size_t sv_utf8_width(stringv sv) {
+  size_t width = 0;
+  size_t i = 0;
+
+  while (i < sv.len) {
+    size_t run = utf8_ascii_prefix(sv.p + i, sv.len - i);
+    for (size_t j = i; j < i + run; j++) {
+      unsigned char c = sv.p[j];
+      width += c >= 0x20 && c != 0x7F;
+    }
+    i += run;
+    if (i == sv.len) {
+      break;
+    }
+
+    uint32_t cp;
+    size_t n = utf8_decode(sv.p + i, sv.len - i, &cp);
+    if (n == 0) {
+      /* Shown as U+FFFD */
+      width += 1;
+      n = 1;
+    } else {
+      width += utf8_cp_width(cp);
+    }
+    i += n;
+  }
+
+  return width;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include "ma.h"
+
+#define UTF8_REPLACEMENT 0xFFFD
+
+/*
+ * Bulk kernels. The implementation (avx2, ssse3 or scalar) is picked on
+ * first use from what the CPU supports; utf8_use_kernel overrides it and
+ * returns NULL if the named kernel is unknown or unsupported.
+ */
+bool utf8_validate(const char *p, size_t len);
+size_t utf8_count(const char *p, size_t len);       /* codepoints in valid input */
+size_t utf8_ascii_prefix(const char *p, size_t len);
+const char* utf8_kernel(void);
+const char* utf8_use_kernel(const char *name);
+
+/* Single codepoints: bytes consumed (0 if invalid) and terminal columns */
+size_t utf8_decode(const char *p, size_t len, uint32_t *cp);
+int utf8_cp_width(uint32_t cp);
+
+bool sv_utf8_valid(stringv sv);
+size_t sv_utf8_len(stringv sv);
+uint32_t sv_utf8_chop_codepoint(stringv *sv);
+stringv sv_utf8_chop_left(stringv *sv, size_t n);
+stringv sv_utf8_trim_left(stringv sv);
+stringv sv_utf8_trim_right(stringv sv);
+stringv sv_utf8_trim(stringv sv);
+size_t sv_utf8_width(stringv sv);